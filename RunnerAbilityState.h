@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+
+/*Runtime state of the Dash. only allocated for controllers that can dash*/
+struct FRunnerDashState
+{
+	/*tells us if this contoller is Dashing, stays true during the cooldown*/
+	bool bDashing = false;
+	/*tells us if the Dash is still moving the character*/
+	bool bExecuting = false;
+	/*ID of the root motion source moving the character during the Dash*/
+	uint16 RootMotionSourceID = 0;
+	/*Timer handler For The Dash Execute Time then Cooldown*/
+	FTimerHandle TimerHandle;
+};
+
+/*Runtime state of the vault look ahead. only allocated for controllers that can vault*/
+struct FRunnerVaultState
+{
+	/*tells us if the last look ahead found a ledge we can vault*/
+	bool bHasCandidate = false;
+	/*tells us if the last look ahead found nothing in the way until the next look ahead*/
+	bool bLookAheadClear = false;
+	/*where the look ahead hit the ledge*/
+	FVector LedgeLocation = FVector::ZeroVector;
+	/*normal of the ledge where the look ahead hit it*/
+	FVector LedgeNormal = FVector::ZeroVector;
+	/*which way the character was facing during the look ahead*/
+	FVector Forward = FVector::ZeroVector;
+	/*where the character was during the look ahead*/
+	FVector Location = FVector::ZeroVector;
+	/*world time of the look ahead*/
+	float Time = 0.0f;
+	/*speed of the character on the ground plane during the look ahead*/
+	float Speed = 0.0f;
+	/*how far the look ahead swept*/
+	float LookAheadDistance = 0.0f;
+	/*Timer handler for the look ahead vault query*/
+	FTimerHandle TimerHandle;
+	/*Timer handler for the extra look ahead when the ledge found comes into reach*/
+	FTimerHandle ReachTimerHandle;
+};
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RunnerClearanceBlockerComponent.h"
+#include "RunnerClearanceSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Components/PrimitiveComponent.h"
+
+
+URunnerClearanceBlockerComponent::URunnerClearanceBlockerComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void URunnerClearanceBlockerComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	TArray<UPrimitiveComponent*> OwnerPrimitives;
+	GetOwner()->GetComponents<UPrimitiveComponent>(OwnerPrimitives);
+
+	for (UPrimitiveComponent* Primitive : OwnerPrimitives)
+	{
+		//static geometry never moves and what does not collide cannot block a trace
+		if (Primitive->Mobility != EComponentMobility::Movable || !Primitive->IsCollisionEnabled())
+		{
+			continue;
+		}
+
+		Primitives.Add(Primitive);
+		LastBounds.Add(Primitive->Bounds.GetBox());
+		Primitive->TransformUpdated.AddUObject(this, &URunnerClearanceBlockerComponent::OnPrimitiveTransformUpdated);
+
+		/*results may have been cached before we were spawned under them*/
+		InvalidateClearance(LastBounds.Last());
+	}
+}
+
+void URunnerClearanceBlockerComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	for (int32 Index = 0; Index < Primitives.Num(); ++Index)
+	{
+		if (Primitives[Index] != nullptr)
+		{
+			Primitives[Index]->TransformUpdated.RemoveAll(this);
+		}
+
+		/*the blocker is going away, what was under it may be clear now*/
+		InvalidateClearance(LastBounds[Index]);
+	}
+
+	Primitives.Reset();
+	LastBounds.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void URunnerClearanceBlockerComponent::OnPrimitiveTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	const int32 Index = Primitives.IndexOfByKey(UpdatedComponent);
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	//bounds are updated before the transform update is broadcast
+	const FBox NewBounds = Primitives[Index]->Bounds.GetBox();
+
+	/*both where it was and where it is now changed*/
+	InvalidateClearance(LastBounds[Index]);
+	InvalidateClearance(NewBounds);
+
+	LastBounds[Index] = NewBounds;
+}
+
+void URunnerClearanceBlockerComponent::InvalidateClearance(const FBox& Box) const
+{
+	if (!Box.IsValid)
+	{
+		return;
+	}
+
+	UWorld* World = GetWorld();
+	URunnerClearanceSubsystem* ClearanceSubsystem = World != nullptr ? World->GetSubsystem<URunnerClearanceSubsystem>() : nullptr;
+	if (ClearanceSubsystem != nullptr)
+	{
+		ClearanceSubsystem->InvalidateBox(Box);
+	}
+}
@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "RunnerClearanceBlockerComponent.generated.h"
+
+class UPrimitiveComponent;
+
+/*
+Put this on movable geometry agents can crouch under (doors, platforms...).
+every time one of the movable colliding primitives of the actor moves, the cached clearance results where it was and where it is now are thrown away
+so nobody stands up into it
+*/
+UCLASS(ClassGroup = (Movement), meta = (BlueprintSpawnableComponent))
+class RUNNERGAME_API URunnerClearanceBlockerComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	URunnerClearanceBlockerComponent();
+
+protected:
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called when the game ends or when destroyed
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/*Called every time one of the watched primitives moves*/
+	void OnPrimitiveTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	/*throws away the cached clearance results inside Box*/
+	void InvalidateClearance(const FBox& Box) const;
+
+	/*the movable colliding primitives of the owner we watch*/
+	UPROPERTY()
+	TArray<UPrimitiveComponent*> Primitives;
+
+	/*bounds of each watched primitive the last time it moved*/
+	TArray<FBox> LastBounds;
+};
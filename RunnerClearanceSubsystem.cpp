@@ -0,0 +1,209 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RunnerClearanceSubsystem.h"
+#include "Engine/World.h"
+
+
+URunnerClearanceSubsystem::URunnerClearanceSubsystem()
+{
+	CellSize = 25.0f;
+	HeightQuantization = 10.0f;
+	StalenessWindow = 0.25f;
+	MaxEntries = 4096;
+	NumEntries = 0;
+	MaxHeightBucket = 0;
+}
+
+void URunnerClearanceSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	/*these come from the config and we divide by them*/
+	CellSize = FMath::Max(CellSize, 1.0f);
+	HeightQuantization = FMath::Max(HeightQuantization, 1.0f);
+	MaxEntries = FMath::Max(MaxEntries, 1);
+}
+
+bool URunnerClearanceSubsystem::TraceClearance(const UWorld* World, const FVector& FeetLocation, float Height, const AActor* IgnoredActor)
+{
+	FVector TraceEnd = FeetLocation;
+	TraceEnd.Z += Height;
+
+	FHitResult TraceHit;
+
+	//we need to tell the line trace to ignore collision with the one asking
+	FCollisionQueryParams QueryParams;
+	QueryParams.AddIgnoredActor(IgnoredActor);
+
+	//if we hit something we cant stand up
+	return !World->LineTraceSingleByChannel(TraceHit, FeetLocation, TraceEnd, ECC_Visibility, QueryParams);
+}
+
+bool URunnerClearanceSubsystem::HasClearance(const FVector& FeetLocation, float Height, const AActor* IgnoredActor, bool& bOutTraced)
+{
+	bOutTraced = false;
+
+	UWorld* World = GetWorld();
+	const float CurrentTime = World->GetTimeSeconds();
+
+	const FIntVector Cell = GetCell(FeetLocation);
+	const int32 HeightBucket = FMath::CeilToInt(Height / HeightQuantization);
+
+	FRunnerClearanceCell* CachedCell = Cells.Find(Cell);
+	FRunnerClearanceEntry* CachedEntry = CachedCell != nullptr ? CachedCell->Entries.FindByPredicate([HeightBucket](const FRunnerClearanceEntry& Entry) { return Entry.HeightBucket == HeightBucket; }) : nullptr;
+
+	if (CachedEntry != nullptr && CurrentTime - CachedEntry->Time <= StalenessWindow)
+	{
+		return CachedEntry->bClear;
+	}
+
+	//feet anywhere in the cell can be up to one HeightQuantization above ours, so we trace one bucket further for the result to hold for all of them
+	const bool bClear = TraceClearance(World, FeetLocation, (HeightBucket + 1) * HeightQuantization, IgnoredActor);
+	bOutTraced = true;
+
+	if (CachedEntry != nullptr)
+	{
+		CachedEntry->bClear = bClear;
+		CachedEntry->Time = CurrentTime;
+		return bClear;
+	}
+
+	if (NumEntries >= MaxEntries)
+	{
+		RemoveStaleEntries(CurrentTime);
+
+		/*everything is still fresh, make room anyway*/
+		if (NumEntries >= MaxEntries)
+		{
+			RemoveOldestEntry();
+		}
+	}
+
+	FRunnerClearanceEntry NewEntry;
+	NewEntry.HeightBucket = HeightBucket;
+	NewEntry.bClear = bClear;
+	NewEntry.Time = CurrentTime;
+
+	Cells.FindOrAdd(Cell).Entries.Add(NewEntry);
+	++NumEntries;
+	MaxHeightBucket = FMath::Max(MaxHeightBucket, HeightBucket);
+
+	return bClear;
+}
+
+void URunnerClearanceSubsystem::InvalidateBox(const FBox& Box)
+{
+	const FIntVector MinCell = GetCell(Box.Min);
+	const FIntVector MaxCell = GetCell(Box.Max);
+
+	//the box can cover a ceiling above feet from lower cells, the highest trace we cached tells us how far down to look
+	const int32 LowestZ = MinCell.Z - MaxHeightBucket - 1;
+
+	const int64 NumRangeCells = int64(MaxCell.X - MinCell.X + 1) * int64(MaxCell.Y - MinCell.Y + 1) * int64(MaxCell.Z - LowestZ + 1);
+
+	/*a small box only looks at the cells it covers*/
+	if (NumRangeCells <= Cells.Num())
+	{
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+			{
+				for (int32 Z = LowestZ; Z <= MaxCell.Z; ++Z)
+				{
+					const FIntVector Cell(X, Y, Z);
+					FRunnerClearanceCell* CachedCell = Cells.Find(Cell);
+					if (CachedCell != nullptr && RemoveEntriesReaching(Cell, *CachedCell, MinCell.Z))
+					{
+						Cells.Remove(Cell);
+					}
+				}
+			}
+		}
+		return;
+	}
+
+	/*a box bigger than the cache is cheaper to check against every cached cell*/
+	for (auto It = Cells.CreateIterator(); It; ++It)
+	{
+		const FIntVector& Cell = It.Key();
+		if (Cell.X >= MinCell.X && Cell.X <= MaxCell.X && Cell.Y >= MinCell.Y && Cell.Y <= MaxCell.Y && Cell.Z >= LowestZ && Cell.Z <= MaxCell.Z)
+		{
+			if (RemoveEntriesReaching(Cell, It.Value(), MinCell.Z))
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+}
+
+void URunnerClearanceSubsystem::InvalidateAll()
+{
+	Cells.Reset();
+	NumEntries = 0;
+	MaxHeightBucket = 0;
+}
+
+FIntVector URunnerClearanceSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt(Location.X / CellSize),
+		FMath::FloorToInt(Location.Y / CellSize),
+		FMath::FloorToInt(Location.Z / HeightQuantization));
+}
+
+bool URunnerClearanceSubsystem::RemoveEntriesReaching(const FIntVector& Cell, FRunnerClearanceCell& CellEntries, int32 MinZ)
+{
+	//a trace from this cell ends at most in the cell HeightBucket + 1 above it
+	NumEntries -= CellEntries.Entries.RemoveAll([&Cell, MinZ](const FRunnerClearanceEntry& Entry) { return Cell.Z + Entry.HeightBucket + 1 >= MinZ; });
+
+	return CellEntries.Entries.Num() == 0;
+}
+
+void URunnerClearanceSubsystem::RemoveStaleEntries(float CurrentTime)
+{
+	for (auto It = Cells.CreateIterator(); It; ++It)
+	{
+		TArray<FRunnerClearanceEntry, TInlineAllocator<2>>& CellEntries = It.Value().Entries;
+		NumEntries -= CellEntries.RemoveAll([this, CurrentTime](const FRunnerClearanceEntry& Entry) { return CurrentTime - Entry.Time > StalenessWindow; });
+
+		if (CellEntries.Num() == 0)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void URunnerClearanceSubsystem::RemoveOldestEntry()
+{
+	FIntVector OldestCell = FIntVector::ZeroValue;
+	int32 OldestIndex = INDEX_NONE;
+	float OldestTime = TNumericLimits<float>::Max();
+
+	for (const TPair<FIntVector, FRunnerClearanceCell>& CachedCell : Cells)
+	{
+		for (int32 Index = 0; Index < CachedCell.Value.Entries.Num(); ++Index)
+		{
+			if (CachedCell.Value.Entries[Index].Time < OldestTime)
+			{
+				OldestCell = CachedCell.Key;
+				OldestIndex = Index;
+				OldestTime = CachedCell.Value.Entries[Index].Time;
+			}
+		}
+	}
+
+	if (OldestIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	FRunnerClearanceCell& CellEntries = Cells.FindChecked(OldestCell);
+	CellEntries.Entries.RemoveAtSwap(OldestIndex);
+	--NumEntries;
+
+	if (CellEntries.Entries.Num() == 0)
+	{
+		Cells.Remove(OldestCell);
+	}
+}
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RunnerClearanceSubsystem.generated.h"
+
+/*A cached clearance result*/
+struct FRunnerClearanceEntry
+{
+	/*the quantized height we checked for*/
+	int32 HeightBucket;
+	/*tells us if nothing was above the feet*/
+	bool bClear;
+	/*world time at which the trace was done*/
+	float Time;
+};
+
+/*The cached clearance results of every height checked from one cell*/
+struct FRunnerClearanceCell
+{
+	/*one result per height bucket, most cells only ever see standing up from crouch or slide*/
+	TArray<FRunnerClearanceEntry, TInlineAllocator<2>> Entries;
+};
+
+/*
+Shares the result of the "can i stand up here" trace between every controller in the world.
+agents crouching or sliding under the same overhang reuse one trace instead of each running their own.
+movable geometry (doors, platforms...) gets a URunnerClearanceBlockerComponent so the cells it moves through are invalidated
+*/
+UCLASS(Config = Game)
+class RUNNERGAME_API URunnerClearanceSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	URunnerClearanceSubsystem();
+
+	// Called when the world creates this subsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/*traces a vertical line of Height above FeetLocation, true if nothing blocks it. the one trace both the cache and controllers without it use*/
+	static bool TraceClearance(const UWorld* World, const FVector& FeetLocation, float Height, const AActor* IgnoredActor);
+
+	/*tells us if nothing blocks a vertical line of Height above FeetLocation. bOutTraced is true when the cache could not answer and a trace was done*/
+	bool HasClearance(const FVector& FeetLocation, float Height, const AActor* IgnoredActor, bool& bOutTraced);
+
+	/*throws away every cached result in the cells touched by Box. call this when movable geometry moves*/
+	UFUNCTION(BlueprintCallable, Category = "Movement|Clearance")
+	void InvalidateBox(const FBox& Box);
+
+	/*throws away every cached result*/
+	UFUNCTION(BlueprintCallable, Category = "Movement|Clearance")
+	void InvalidateAll();
+
+protected:
+
+	/*size of a cell on X and Y. smaller is more precise but shares less*/
+	UPROPERTY(Config)
+	float CellSize;
+	/*size of a cell on Z, also used to group capsule heights together*/
+	UPROPERTY(Config)
+	float HeightQuantization;
+	/*how long a cached result can be reused before we trace again*/
+	UPROPERTY(Config)
+	float StalenessWindow;
+	/*when the cache grows past this we drop the stale results, or the oldest one if none are stale*/
+	UPROPERTY(Config)
+	int32 MaxEntries;
+
+	/*the cached results, by the cell the feet were in*/
+	TMap<FIntVector, FRunnerClearanceCell> Cells;
+
+	/*how many results are cached across every cell*/
+	int32 NumEntries;
+
+	/*the highest height bucket ever cached, tells invalidation how far below a box a trace could reach from*/
+	int32 MaxHeightBucket;
+
+	/*the cell a location is in*/
+	FIntVector GetCell(const FVector& Location) const;
+
+	/*drops the results of Cell whose trace could reach up to MinZ, returns true if the cell is now empty*/
+	bool RemoveEntriesReaching(const FIntVector& Cell, FRunnerClearanceCell& CellEntries, int32 MinZ);
+
+	/*drops every result older than StalenessWindow*/
+	void RemoveStaleEntries(float CurrentTime);
+
+	/*drops the result that was traced the longest time ago*/
+	void RemoveOldestEntry();
+};
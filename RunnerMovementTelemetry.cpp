@@ -0,0 +1,189 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RunnerMovementTelemetry.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Async/Async.h"
+
+namespace
+{
+	/*"RMTR" in the first bytes of the file*/
+	const uint32 RunnerTelemetryMagic = 0x52544D52;
+	const uint32 RunnerTelemetryVersion = 2;
+
+	/*Header at the start of every telemetry file*/
+	struct FRunnerTelemetryFileHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint32 RecordSize;
+		uint32 NumRecords;
+	};
+}
+
+FRunnerMovementTelemetry::FRunnerMovementTelemetry()
+	: Head(0)
+	, NumAppended(0)
+{
+}
+
+FRunnerMovementTelemetry::~FRunnerMovementTelemetry()
+{
+	/*the worker thread reads FlushRecords, wait for it*/
+	if (PendingFlush.IsValid())
+	{
+		PendingFlush.Wait();
+	}
+}
+
+void FRunnerMovementTelemetry::Initialize(int32 Capacity)
+{
+	if (PendingFlush.IsValid())
+	{
+		PendingFlush.Wait();
+	}
+
+	Records.Reset();
+	Records.SetNumZeroed(FMath::Max(Capacity, 1));
+	FlushRecords.Reset(Records.Num());
+	Head = 0;
+	NumAppended = 0;
+}
+
+bool FRunnerMovementTelemetry::FlushToFileAsync(const FString& FilePath)
+{
+	if (!IsInitialized())
+	{
+		return false;
+	}
+
+	if (PendingFlush.IsValid() && !PendingFlush.IsReady())
+	{
+		return false;
+	}
+
+	CopyToFlushRecords();
+
+	PendingFlush = Async(EAsyncExecution::ThreadPool, [this, FilePath]()
+	{
+		return WriteRecordsToFile(FilePath, FlushRecords);
+	});
+
+	return true;
+}
+
+bool FRunnerMovementTelemetry::SaveToFile(const FString& FilePath)
+{
+	if (!IsInitialized())
+	{
+		return false;
+	}
+
+	if (PendingFlush.IsValid())
+	{
+		PendingFlush.Wait();
+	}
+
+	CopyToFlushRecords();
+
+	return WriteRecordsToFile(FilePath, FlushRecords);
+}
+
+void FRunnerMovementTelemetry::CopyToFlushRecords()
+{
+	const int32 NumRecords = static_cast<int32>(FMath::Min<uint64>(NumAppended, Records.Num()));
+
+	/*once the ring wrapped the oldest record is the one at Head*/
+	const int32 OldestIndex = NumRecords < Records.Num() ? 0 : Head;
+	const int32 NumUntilEnd = FMath::Min(NumRecords, Records.Num() - OldestIndex);
+
+	/*FlushRecords was allocated with the ring so this does not allocate*/
+	FlushRecords.Reset();
+	FlushRecords.Append(Records.GetData() + OldestIndex, NumUntilEnd);
+	FlushRecords.Append(Records.GetData(), NumRecords - NumUntilEnd);
+}
+
+bool FRunnerMovementTelemetry::WriteRecordsToFile(const FString& FilePath, const TArray<FRunnerMovementTelemetryRecord>& RecordsToWrite)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(FilePath));
+
+	const FString TempFilePath = FilePath + TEXT(".tmp");
+
+	{
+		TUniquePtr<IFileHandle> FileHandle(PlatformFile.OpenWrite(*TempFilePath));
+		if (!FileHandle)
+		{
+			return false;
+		}
+
+		FRunnerTelemetryFileHeader Header;
+		Header.Magic = RunnerTelemetryMagic;
+		Header.Version = RunnerTelemetryVersion;
+		Header.RecordSize = sizeof(FRunnerMovementTelemetryRecord);
+		Header.NumRecords = RecordsToWrite.Num();
+
+		if (!FileHandle->Write(reinterpret_cast<const uint8*>(&Header), sizeof(Header))
+			|| !FileHandle->Write(reinterpret_cast<const uint8*>(RecordsToWrite.GetData()), RecordsToWrite.Num() * sizeof(FRunnerMovementTelemetryRecord)))
+		{
+			return false;
+		}
+	}
+
+	/*replace the previous flush only once the new one is complete*/
+	PlatformFile.DeleteFile(*FilePath);
+	return PlatformFile.MoveFile(*FilePath, *TempFilePath);
+}
+
+bool FRunnerMovementTelemetry::ExportToCSV(const FString& BinaryFilePath, const FString& CSVFilePath)
+{
+	TArray<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(FileData, *BinaryFilePath))
+	{
+		return false;
+	}
+
+	if (FileData.Num() < static_cast<int32>(sizeof(FRunnerTelemetryFileHeader)))
+	{
+		return false;
+	}
+
+	FRunnerTelemetryFileHeader Header;
+	FMemory::Memcpy(&Header, FileData.GetData(), sizeof(Header));
+
+	/*make sure we are reading a file we know how to read*/
+	if (Header.Magic != RunnerTelemetryMagic || Header.Version != RunnerTelemetryVersion || Header.RecordSize != sizeof(FRunnerMovementTelemetryRecord))
+	{
+		return false;
+	}
+
+	if (FileData.Num() < static_cast<int64>(sizeof(Header)) + static_cast<int64>(Header.NumRecords) * Header.RecordSize)
+	{
+		return false;
+	}
+
+	FString CSV = TEXT("Time,DeltaTime,TickDuration,MovementState,Crouching,Sprinting,Dashing,Falling,VelocityX,VelocityY,VelocityZ,FloorNormalX,FloorNormalY,FloorNormalZ,TraceCount\n");
+
+	const FRunnerMovementTelemetryRecord* FileRecords = reinterpret_cast<const FRunnerMovementTelemetryRecord*>(FileData.GetData() + sizeof(Header));
+	for (uint32 Index = 0; Index < Header.NumRecords; ++Index)
+	{
+		FRunnerMovementTelemetryRecord Record;
+		FMemory::Memcpy(&Record, FileRecords + Index, sizeof(Record));
+
+		const ERunnerTelemetryFlags Flags = static_cast<ERunnerTelemetryFlags>(Record.Flags);
+
+		CSV += FString::Printf(TEXT("%f,%f,%f,%d,%d,%d,%d,%d,%f,%f,%f,%f,%f,%f,%d\n"),
+			Record.Time, Record.DeltaTime, Record.TickDuration, Record.MovementState,
+			EnumHasAnyFlags(Flags, ERunnerTelemetryFlags::Crouching) ? 1 : 0,
+			EnumHasAnyFlags(Flags, ERunnerTelemetryFlags::Sprinting) ? 1 : 0,
+			EnumHasAnyFlags(Flags, ERunnerTelemetryFlags::Dashing) ? 1 : 0,
+			EnumHasAnyFlags(Flags, ERunnerTelemetryFlags::Falling) ? 1 : 0,
+			Record.Velocity.X, Record.Velocity.Y, Record.Velocity.Z,
+			Record.FloorNormal.X, Record.FloorNormal.Y, Record.FloorNormal.Z,
+			Record.TraceCount);
+	}
+
+	return FFileHelper::SaveStringToFile(CSV, *CSVFilePath);
+}
@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+/*What the controller was doing on a given frame, packed in FRunnerMovementTelemetryRecord::Flags*/
+enum class ERunnerTelemetryFlags : uint8
+{
+	None = 0,
+	Crouching = 1 << 0,
+	Sprinting = 1 << 1,
+	Dashing = 1 << 2,
+	Falling = 1 << 3
+};
+ENUM_CLASS_FLAGS(ERunnerTelemetryFlags)
+
+/*One frame of movement. this is written as is to the telemetry file so keep it fixed size*/
+struct FRunnerMovementTelemetryRecord
+{
+	/*world time of the frame*/
+	float Time;
+	/*the frame delta time*/
+	float DeltaTime;
+	/*how long the controller tick took, in seconds*/
+	float TickDuration;
+	/*velocity of the character*/
+	FVector Velocity;
+	/*normal of the floor the character is standing on*/
+	FVector FloorNormal;
+	/*how many traces the controller issued this frame*/
+	uint16 TraceCount;
+	/*EMovementState of the controller*/
+	uint8 MovementState;
+	/*ERunnerTelemetryFlags of the controller*/
+	uint8 Flags;
+};
+static_assert(sizeof(FRunnerMovementTelemetryRecord) == 40, "Telemetry record layout changed, bump RunnerTelemetryVersion");
+
+/*
+Fixed size ring of per frame movement records.
+the ring is allocated once, appending only copies the record so it is cheap enough to leave on every frame.
+FlushToFileAsync copies the ring to a preallocated buffer and writes it on a worker thread, so flushing often keeps the trace if the game crashes.
+the file can be turned into a CSV offline with ExportToCSV, see URunnerTelemetryExportCommandlet
+*/
+class RUNNERGAME_API FRunnerMovementTelemetry
+{
+public:
+
+	FRunnerMovementTelemetry();
+	~FRunnerMovementTelemetry();
+
+	/*allocates the ring. nothing is recorded until this is called*/
+	void Initialize(int32 Capacity);
+
+	/*tells us if the ring was allocated*/
+	FORCEINLINE bool IsInitialized() const { return Records.Num() > 0; }
+
+	/*adds a record, overwriting the oldest one when the ring is full*/
+	FORCEINLINE void Append(const FRunnerMovementTelemetryRecord& Record)
+	{
+		Records[Head] = Record;
+		Head = (Head + 1) % Records.Num();
+		++NumAppended;
+	}
+
+	/*writes the records currently in the ring, oldest first, to a binary file on a worker thread.
+	returns false without doing anything when the previous flush is still writing*/
+	bool FlushToFileAsync(const FString& FilePath);
+
+	/*writes the records currently in the ring, oldest first, to a binary file and waits for it. use when play ends*/
+	bool SaveToFile(const FString& FilePath);
+
+	/*reads a file written by SaveToFile and writes it back as a CSV with one column per field*/
+	static bool ExportToCSV(const FString& BinaryFilePath, const FString& CSVFilePath);
+
+private:
+
+	/*copies the ring, oldest first, into FlushRecords*/
+	void CopyToFlushRecords();
+
+	/*writes the records next to FilePath then moves them over it, so a crash while writing never leaves a broken file*/
+	static bool WriteRecordsToFile(const FString& FilePath, const TArray<FRunnerMovementTelemetryRecord>& RecordsToWrite);
+
+	/*the ring itself*/
+	TArray<FRunnerMovementTelemetryRecord> Records;
+	/*where the next record goes*/
+	int32 Head;
+	/*how many records were appended since Initialize, can be more than the ring holds*/
+	uint64 NumAppended;
+	/*copy of the ring being written to disk, allocated with the ring*/
+	TArray<FRunnerMovementTelemetryRecord> FlushRecords;
+	/*the flush currently writing, if any*/
+	TFuture<bool> PendingFlush;
+};
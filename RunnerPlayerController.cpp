@@ -3,10 +3,16 @@
 
 #include "RunnerPlayerController.h"
 #include "RunnerGameCharacter.h"
+#include "RunnerClearanceSubsystem.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "Camera/CameraComponent.h"
 #include "GameFramework/SpringArmComponent.h"
+#include "Curves/CurveFloat.h"
+#include "GameFramework/RootMotionSource.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogRunnerPlayerController, Log, All);
 
 
 ARunnerPlayerController::ARunnerPlayerController()
@@ -19,6 +25,15 @@ ARunnerPlayerController::ARunnerPlayerController()
 	BaseLookUpRate = 25.f;
 	PlayerPerspective = EPlayerPerspective::IR_ThirdPerson;
 
+	// 
+	// INPUT
+	//
+	InputDeadZone = 0.1f;
+	InputResponseExponent = 1.0f;
+	PendingMoveInput = FVector2D::ZeroVector;
+	PendingLookInput = FVector2D::ZeroVector;
+	PendingLookRateInput = FVector2D::ZeroVector;
+
 	// 
 	// WALKING
 	//
@@ -46,6 +61,12 @@ ARunnerPlayerController::ARunnerPlayerController()
 	//
 	MovementState = EMovementState::IR_Walking;
 
+	//
+	// ABILITIES
+	//
+	/*by default a controller can do everything, strip abilities per blueprint*/
+	EnabledAbilities = static_cast<uint8>(ERunnerAbility::IR_All);
+
 	//
 	// SLIDING
 	//
@@ -54,13 +75,51 @@ ARunnerPlayerController::ARunnerPlayerController()
 	SlideSpeed = SprintSpeed * 2.0f;
 	SlideMultiplier = 150000;
 
+	//
+	// VAULTING
+	//
+	VaultQueryInterval = 0.05f;
+	VaultReachDistance = 100.0f;
+	VaultCandidateMaxAge = 0.2f;
+	VaultCandidateMinFacingDot = 0.9f;
+
 	//
 	// DASHING
 	//
-	DashDistance = 6000.0f;
+	DashDistance = 600.0f;
 	DashCoolDown = 1.0f;
 	DashExecTime = 0.1f;
-	DashBrakingFrictionFactor = 0.f;
+	DashCurve = nullptr;
+
+	//
+	// TELEMETRY
+	//
+	bRecordMovementTelemetry = false;
+	/*a minute at 60 frames per second*/
+	MovementTelemetryCapacity = 3600;
+	MovementTelemetryFlushInterval = 10.0f;
+	FrameTraceCount = 0;
+}
+
+void ARunnerPlayerController::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	// 
+	// ABILITIES
+	//
+	/*before the input gets bound, so only valid abilities get bound*/
+	ValidateAbilities();
+
+	/*abilities this controller does not have get no state at all*/
+	if (HasAbility(ERunnerAbility::IR_Dash))
+	{
+		DashState = MakeUnique<FRunnerDashState>();
+	}
+	if (HasAbility(ERunnerAbility::IR_Vault))
+	{
+		VaultState = MakeUnique<FRunnerVaultState>();
+	}
 }
 
 void ARunnerPlayerController::BeginPlay()
@@ -83,16 +142,89 @@ void ARunnerPlayerController::BeginPlay()
 	/*Getting the capsule half height*/
 	StandingCapsuleHalfHeight = GetCharacter()->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
 
+	// 
+	// VAULTING
+	//
+	/*look ahead for ledges at a reduced rate instead of sweeping on the jump press*/
+	if (VaultState)
+	{
+		GetWorldTimerManager().SetTimer(VaultState->TimerHandle, this, &ARunnerPlayerController::UpdateVaultCandidate, VaultQueryInterval, true);
+	}
+
+	//
+	// TELEMETRY
+	//
+	/*allocate the whole ring now so recording never allocates*/
+	if (bRecordMovementTelemetry)
+	{
+		MovementTelemetry.Initialize(MovementTelemetryCapacity);
+
+		/*one file per session so we never overwrite a previous trace*/
+		MovementTelemetryFilePath = FPaths::ProjectSavedDir() / TEXT("Telemetry") / FString::Printf(TEXT("%s_%s.bin"), *GetName(), *FDateTime::Now().ToString());
+
+		if (MovementTelemetryFlushInterval > 0.0f)
+		{
+			GetWorldTimerManager().SetTimer(TimerHandle_TelemetryFlush, this, &ARunnerPlayerController::FlushMovementTelemetry, MovementTelemetryFlushInterval, true);
+		}
+	}
+}
+
+void ARunnerPlayerController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (MovementTelemetry.IsInitialized())
+	{
+		GetWorldTimerManager().ClearTimer(TimerHandle_TelemetryFlush);
+		MovementTelemetry.SaveToFile(MovementTelemetryFilePath);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+#if WITH_EDITOR
+void ARunnerPlayerController::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	if (PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(ARunnerPlayerController, EnabledAbilities))
+	{
+		ValidateAbilities();
+	}
+}
+#endif
+
+void ARunnerPlayerController::OnUnPossess()
+{
+	/*the dash belongs to the pawn we are leaving, take it off and still start the cooldown*/
+	if (DashState && DashState->bExecuting)
+	{
+		if (GetCharacter() != nullptr)
+		{
+			GetCharacter()->GetCharacterMovement()->RemoveRootMotionSourceByID(DashState->RootMotionSourceID);
+			GetCharacter()->GetMovementComponent()->StopMovementImmediately();
+		}
+
+		GetWorldTimerManager().ClearTimer(DashState->TimerHandle);
+		StopDashing();
+	}
+
+	Super::OnUnPossess();
 }
 
 void ARunnerPlayerController::Tick(float DeltaTime)
 {
+	const double TickStartTime = FPlatformTime::Seconds();
+
 	Super::Tick(DeltaTime);
 	
 	if ((MovementState == EMovementState::IR_Crouching || MovementState == EMovementState::IR_Sliding) && CanStand() && !bCrouching)
 	{
 		ResolveMovementState();
 	}
+
+	if (MovementTelemetry.IsInitialized())
+	{
+		RecordMovementTelemetry(DeltaTime, static_cast<float>(FPlatformTime::Seconds() - TickStartTime));
+	}
 }
 
 void ARunnerPlayerController::SetupInputComponent()
@@ -112,67 +244,135 @@ void ARunnerPlayerController::SetupInputComponent()
 		//
 		InputComponent->BindAxis("TurnRate", this, &ARunnerPlayerController::TurnRate);
 		InputComponent->BindAxis("LookUpRate", this, &ARunnerPlayerController::LookUpRate);
+		InputComponent->BindAxis("TurnRateGamepad", this, &ARunnerPlayerController::TurnRateGamepad);
+		InputComponent->BindAxis("LookUpRateGamepad", this, &ARunnerPlayerController::LookUpRateGamepad);
 
 		// 
 		// JUMP
 		//
-		InputComponent->BindAction("Jump", IE_Pressed, this, &ARunnerPlayerController::StartJumping);
+		if (HasAbility(ERunnerAbility::IR_Vault))
+		{
+			InputComponent->BindAction("Jump", IE_Pressed, this, &ARunnerPlayerController::StartVaultingOrJumping);
+		}
+		else
+		{
+			InputComponent->BindAction("Jump", IE_Pressed, this, &ARunnerPlayerController::StartJumping);
+		}
 		InputComponent->BindAction("Jump", IE_Released, this, &ARunnerPlayerController::StopJumping);
 
 		// 
 		// CROUCH
 		// 
-		InputComponent->BindAction("Crouch", IE_Pressed, this, &ARunnerPlayerController::StartCrouching);
-		InputComponent->BindAction("Crouch", IE_Released, this, &ARunnerPlayerController::StopCrouching);
+		if (HasAbility(ERunnerAbility::IR_Crouch))
+		{
+			InputComponent->BindAction("Crouch", IE_Pressed, this, &ARunnerPlayerController::StartCrouching);
+			InputComponent->BindAction("Crouch", IE_Released, this, &ARunnerPlayerController::StopCrouching);
+		}
 
 		// 
 		// SPRINTING
 		// 
-		InputComponent->BindAction("Sprint", IE_Pressed, this, &ARunnerPlayerController::StartSprinting);
-		InputComponent->BindAction("Sprint", IE_Released, this, &ARunnerPlayerController::StopSprinting);
+		if (HasAbility(ERunnerAbility::IR_Sprint))
+		{
+			InputComponent->BindAction("Sprint", IE_Pressed, this, &ARunnerPlayerController::StartSprinting);
+			InputComponent->BindAction("Sprint", IE_Released, this, &ARunnerPlayerController::StopSprinting);
+		}
 
 		// 
 		// DASHING
 		// 
-		InputComponent->BindAction("Dash", IE_Pressed, this, &ARunnerPlayerController::StartDashing);
+		if (HasAbility(ERunnerAbility::IR_Dash))
+		{
+			InputComponent->BindAction("Dash", IE_Pressed, this, &ARunnerPlayerController::StartDashing);
+		}
 
 	}
 }
 
-void ARunnerPlayerController::TurnRate(float Rate)
+void ARunnerPlayerController::PostProcessInput(const float DeltaTime, const bool bGamePaused)
 {
-	if (Rate != 0.0f && GetCharacter() != nullptr)
+	Super::PostProcessInput(DeltaTime, bGamePaused);
+
+	if (!bGamePaused && GetCharacter() != nullptr)
 	{
-		/*turn camera at rate on yaw X axis*/
-		GetCharacter()->AddControllerYawInput(Rate);
+		const FVector2D MoveInput = ApplyInputResponse(PendingMoveInput);
+		const FVector2D LookRateInput = ApplyInputResponse(PendingLookRateInput);
+
+		/*one movement input for both axis*/
+		if (!MoveInput.IsZero())
+		{
+			GetCharacter()->AddMovementInput(GetCharacter()->GetActorForwardVector() * MoveInput.X + GetCharacter()->GetActorRightVector() * MoveInput.Y);
+		}
+
+		/*mouse deltas go in as they are, stick rates are in deg/sec*/
+		const float YawInput = PendingLookInput.X + LookRateInput.X * BaseTurnRate * DeltaTime;
+		const float PitchInput = PendingLookInput.Y + LookRateInput.Y * BaseLookUpRate * DeltaTime;
+
+		/*turn camera on yaw X axis and pitch Y axis*/
+		if (YawInput != 0.0f)
+		{
+			AddYawInput(YawInput);
+		}
+		if (PitchInput != 0.0f)
+		{
+			AddPitchInput(PitchInput);
+		}
 	}
+
+	PendingMoveInput = FVector2D::ZeroVector;
+	PendingLookInput = FVector2D::ZeroVector;
+	PendingLookRateInput = FVector2D::ZeroVector;
 }
 
-void ARunnerPlayerController::LookUpRate(float Rate)
+FVector2D ARunnerPlayerController::ApplyInputResponse(const FVector2D& Value) const
 {
-	if (Rate != 0.0f && GetCharacter() != nullptr)
+	/*radial so diagonals keep their direction*/
+	const float Magnitude = Value.Size();
+	if (Magnitude <= InputDeadZone)
 	{
-		/*turn camera at rate on pitch Y axis*/
-		GetCharacter()->AddControllerPitchInput(Rate);
+		return FVector2D::ZeroVector;
 	}
+
+	/*rescale so the input starts at 0 right after the dead zone*/
+	const float Rescaled = FMath::Min((Magnitude - InputDeadZone) / (1.0f - InputDeadZone), 1.0f);
+
+	return Value / Magnitude * FMath::Pow(Rescaled, InputResponseExponent);
+}
+
+void ARunnerPlayerController::TurnRate(float Rate)
+{
+	/*applied in PostProcessInput with the other axis*/
+	PendingLookInput.X = Rate;
+}
+
+void ARunnerPlayerController::LookUpRate(float Rate)
+{
+	/*applied in PostProcessInput with the other axis*/
+	PendingLookInput.Y = Rate;
+}
+
+void ARunnerPlayerController::TurnRateGamepad(float Rate)
+{
+	/*applied in PostProcessInput with the other axis*/
+	PendingLookRateInput.X = Rate;
+}
+
+void ARunnerPlayerController::LookUpRateGamepad(float Rate)
+{
+	/*applied in PostProcessInput with the other axis*/
+	PendingLookRateInput.Y = Rate;
 }
 
 void ARunnerPlayerController::MoveForward(float Value)
 {
-	if (Value != 0.0f && GetCharacter() != nullptr)
-	{
-		/*add movement in that direction*/
-		GetCharacter()->AddMovementInput(GetCharacter()->GetActorForwardVector(), Value);
-	}
+	/*applied in PostProcessInput with the other axis*/
+	PendingMoveInput.X = Value;
 }
 
 void ARunnerPlayerController::MoveRight(float Value)
 {
-	if (Value != 0.0f && GetCharacter() != nullptr)
-	{
-		/*add movement in that direction*/
-		GetCharacter()->AddMovementInput(GetCharacter()->GetActorRightVector(), Value);
-	}
+	/*applied in PostProcessInput with the other axis*/
+	PendingMoveInput.Y = Value;
 }
 
 bool ARunnerPlayerController::CanSprint()
@@ -209,6 +409,11 @@ void ARunnerPlayerController::SetSprinting(const bool bNewSprinting)
 		return;
 	}
 
+	if (bNewSprinting && !HasAbility(ERunnerAbility::IR_Sprint))
+	{
+		return;
+	}
+
 	bSprinting = bNewSprinting;
 
 	if (MovementState == EMovementState::IR_Sprinting && !bSprinting)
@@ -238,6 +443,11 @@ void ARunnerPlayerController::SetCrouching(bool bNewCrouching)
 	{
 		return;
 	}
+
+	if (bNewCrouching && !HasAbility(ERunnerAbility::IR_Crouch))
+	{
+		return;
+	}
 	bCrouching = bNewCrouching;
 
 	if (MovementState == EMovementState::IR_Crouching && !bCrouching)
@@ -252,7 +462,8 @@ void ARunnerPlayerController::SetCrouching(bool bNewCrouching)
 
 	if (MovementState == EMovementState::IR_Sprinting && bCrouching)
 	{
-		SetMovementState(EMovementState::IR_Sliding);
+		/*without the slide ability crouching while sprinting is just crouching*/
+		SetMovementState(HasAbility(ERunnerAbility::IR_Slide) ? EMovementState::IR_Sliding : EMovementState::IR_Crouching);
 	}
 }
 
@@ -267,22 +478,20 @@ bool ARunnerPlayerController::CanStand()
 	FVector TraceStart = GetCharacter()->GetActorLocation();
 	TraceStart.Z -= GetCharacter()->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
 
-	FVector TraceEnd = TraceStart;
-	TraceEnd.Z +=  StandingCapsuleHalfHeight * 2;
+	/*agents under the same ceiling share one trace*/
+	URunnerClearanceSubsystem* ClearanceSubsystem = GetWorld()->GetSubsystem<URunnerClearanceSubsystem>();
 
-	FHitResult TraceHit;
+	bool bTraced = true;
+	const bool bClear = ClearanceSubsystem != nullptr
+		? ClearanceSubsystem->HasClearance(TraceStart, StandingCapsuleHalfHeight * 2, GetCharacter(), bTraced)
+		: URunnerClearanceSubsystem::TraceClearance(GetWorld(), TraceStart, StandingCapsuleHalfHeight * 2, GetCharacter());
 
-	//we need to tell the line trace to ignore collision with the player
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(GetCharacter());
-
-	//if we hit something we cant stand up
-	if (GetWorld()->LineTraceSingleByChannel(TraceHit, TraceStart, TraceEnd, ECC_Visibility, QueryParams))
+	if (bTraced)
 	{
-		return false;
+		++FrameTraceCount;
 	}
 
-	return true;
+	return bClear;
 }
 
 void ARunnerPlayerController::StartJumping()
@@ -292,12 +501,22 @@ void ARunnerPlayerController::StartJumping()
 		return;
 	}
 
-	if (Cast<ARunnerGameCharacter>(GetCharacter())->VaultingComponent->CanVault())
+	GetCharacter()->Jump();
+}
+
+void ARunnerPlayerController::StartVaultingOrJumping()
+{
+	if (GetCharacter() == nullptr)
+	{
+		return;
+	}
+
+	if (CanVault())
 	{
 		Vault();
 	}
-	
-	GetCharacter()->Jump();
+
+	StartJumping();
 }
 
 void ARunnerPlayerController::StopJumping()
@@ -311,6 +530,128 @@ void ARunnerPlayerController::StopJumping()
 
 }
 
+void ARunnerPlayerController::UpdateVaultCandidate()
+{
+	VaultState->bHasCandidate = false;
+	VaultState->bLookAheadClear = false;
+
+	if (GetCharacter() == nullptr)
+	{
+		return;
+	}
+
+	/*we only look ahead when the controller is moving fast enough to run into a ledge*/
+	if (MovementState != EMovementState::IR_Sprinting && MovementState != EMovementState::IR_Sliding)
+	{
+		return;
+	}
+
+	UCapsuleComponent* Capsule = GetCharacter()->GetCapsuleComponent();
+	const float StepHeight = GetCharacter()->GetCharacterMovement()->MaxStepHeight;
+
+	/*look as far as the ledge could be reached before the next look ahead*/
+	const FVector Forward = GetCharacter()->GetActorForwardVector().GetSafeNormal2D();
+	const float Speed = GetCharacter()->GetVelocity().Size2D();
+	const float LookAheadDistance = VaultReachDistance + Speed * VaultQueryInterval;
+
+	//the bottom of the capsule is raised by the step height so steps the movement component walks over are not ledges
+	FVector SweepStart = GetCharacter()->GetActorLocation();
+	SweepStart.Z += StepHeight * 0.5f;
+	const FVector SweepEnd = SweepStart + Forward * LookAheadDistance;
+	const FCollisionShape SweepShape = FCollisionShape::MakeCapsule(Capsule->GetScaledCapsuleRadius(), Capsule->GetScaledCapsuleHalfHeight() - StepHeight * 0.5f);
+
+	//we need to tell the sweep to ignore collision with the player
+	FCollisionQueryParams QueryParams;
+	QueryParams.AddIgnoredActor(GetCharacter());
+
+	FHitResult LookAheadHit;
+	++FrameTraceCount;
+
+	VaultState->Forward = Forward;
+	VaultState->Location = GetCharacter()->GetActorLocation();
+	VaultState->Time = GetWorld()->GetTimeSeconds();
+	VaultState->Speed = Speed;
+	VaultState->LookAheadDistance = LookAheadDistance;
+
+	//nothing in the way until the next look ahead, so there is nothing to vault
+	if (!GetWorld()->SweepSingleByChannel(LookAheadHit, SweepStart, SweepEnd, FQuat::Identity, Capsule->GetCollisionObjectType(), SweepShape, QueryParams, FCollisionResponseParams(Capsule->GetCollisionResponseToChannels())))
+	{
+		VaultState->bLookAheadClear = true;
+		return;
+	}
+
+	/*the ledge is not in reach of the vaulting component yet, ask again the moment it will be*/
+	if (LookAheadHit.Distance > VaultReachDistance && Speed > 0.0f)
+	{
+		const float TimeToReach = (LookAheadHit.Distance - VaultReachDistance) / Speed;
+		GetWorldTimerManager().SetTimer(VaultState->ReachTimerHandle, this, &ARunnerPlayerController::UpdateVaultCandidate, FMath::Max(TimeToReach, KINDA_SMALL_NUMBER), false);
+		return;
+	}
+
+	ARunnerGameCharacter* RunnerCharacter = Cast<ARunnerGameCharacter>(GetCharacter());
+	++FrameTraceCount;
+	VaultState->bHasCandidate = RunnerCharacter != nullptr && RunnerCharacter->VaultingComponent->CanVault();
+
+	if (VaultState->bHasCandidate)
+	{
+		VaultState->LedgeLocation = LookAheadHit.ImpactPoint;
+		VaultState->LedgeNormal = LookAheadHit.ImpactNormal;
+	}
+}
+
+bool ARunnerPlayerController::CanVault()
+{
+	if (!HasAbility(ERunnerAbility::IR_Vault) || GetCharacter() == nullptr)
+	{
+		return false;
+	}
+
+	const bool bSprintingOrSliding = MovementState == EMovementState::IR_Sprinting || MovementState == EMovementState::IR_Sliding;
+	const FVector Forward = GetCharacter()->GetActorForwardVector().GetSafeNormal2D();
+	const FVector Location = GetCharacter()->GetActorLocation();
+	const float CapsuleRadius = GetCharacter()->GetCapsuleComponent()->GetScaledCapsuleRadius();
+	const float LookAheadAge = GetWorld()->GetTimeSeconds() - VaultState->Time;
+
+	if (bSprintingOrSliding)
+	{
+		/*the ledge has to still be in front of us and in reach*/
+		if (VaultState->bHasCandidate && LookAheadAge <= VaultCandidateMaxAge && FVector::DotProduct(Forward, VaultState->Forward) >= VaultCandidateMinFacingDot)
+		{
+			const float LedgeDistance = FVector::DotProduct(VaultState->LedgeLocation - Location, VaultState->Forward);
+			const float MaxLedgeDistance = VaultReachDistance + CapsuleRadius;
+
+			if (LedgeDistance > 0.0f && LedgeDistance <= MaxLedgeDistance && FVector::DotProduct(-VaultState->LedgeNormal, VaultState->Forward) > 0.0f)
+			{
+				/*a ledge can only be used once*/
+				VaultState->bHasCandidate = false;
+				return true;
+			}
+		}
+
+		/*the look ahead only covered a capsule wide corridor as far as we could get at that speed, we have to still be inside it*/
+		if (VaultState->bLookAheadClear && LookAheadAge <= VaultQueryInterval && !(DashState && DashState->bExecuting))
+		{
+			const float Travelled = FVector::Dist2D(Location, VaultState->Location);
+			const bool bNotFaster = GetCharacter()->GetVelocity().Size2D() <= VaultState->Speed;
+			const bool bStillInReach = Travelled + VaultReachDistance <= VaultState->LookAheadDistance;
+			/*turning moves the reach sideways, at the end of the sweep it must stay within the capsule radius*/
+			const bool bFacingInsideSweep = FVector::DotProduct(Forward, VaultState->Forward) > 0.0f
+				&& FMath::Abs(FVector::CrossProduct(Forward, VaultState->Forward).Z) * VaultState->LookAheadDistance <= CapsuleRadius;
+
+			if (bNotFaster && bStillInReach && bFacingInsideSweep)
+			{
+				return false;
+			}
+		}
+	}
+
+	/*the look ahead cannot answer, ask right away*/
+	VaultState->bHasCandidate = false;
+	ARunnerGameCharacter* RunnerCharacter = Cast<ARunnerGameCharacter>(GetCharacter());
+	++FrameTraceCount;
+	return RunnerCharacter != nullptr && RunnerCharacter->VaultingComponent->CanVault();
+}
+
 void ARunnerPlayerController::StartDashing()
 {
 	SetDashing(true);
@@ -319,9 +660,9 @@ void ARunnerPlayerController::StartDashing()
 
 void ARunnerPlayerController::StopDashing()
 {
-	GetCharacter()->GetMovementComponent()->StopMovementImmediately();
-	GetWorldTimerManager().SetTimer(TimerHandle_Dashing, this, &ARunnerPlayerController::ResetDash, DashCoolDown, false);
-	GetCharacter()->GetCharacterMovement()->BrakingFrictionFactor = WalkingBrakingFrictionFactor;
+	DashState->bExecuting = false;
+	/*always start the cooldown, even without a character, otherwise bDashing never goes back to false*/
+	GetWorldTimerManager().SetTimer(DashState->TimerHandle, this, &ARunnerPlayerController::ResetDash, DashCoolDown, false);
 	OnStopDashing.Broadcast(Cast<ARunnerGameCharacter>(GetCharacter()));
 }
 
@@ -332,35 +673,81 @@ void ARunnerPlayerController::SetDashing(bool bNewDashing)
 		return;
 	}
 
-	if (bNewDashing == bDashing)
+	if (!CanDash())
 	{
 		return;
 	}
 
-	if (!CanDash())
+	if (bNewDashing == DashState->bDashing)
 	{
 		return;
 	}
 
-	bDashing = bNewDashing;
-
-	GetCharacter()->GetCharacterMovement()->BrakingFrictionFactor = DashBrakingFrictionFactor;
 	FVector DashVector = GetCharacter()->GetActorForwardVector();
 	DashVector.Z = 0;
 	DashVector.Normalize();
-	GetCharacter()->LaunchCharacter(DashVector * DashDistance, true, true);
-	GetWorldTimerManager().SetTimer(TimerHandle_Dashing, this, &ARunnerPlayerController::StopDashing, DashExecTime, false);
 
+	/*the client starts the dash right away, the server does its own which may correct the client a little*/
+	if (!HasAuthority())
+	{
+		ServerStartDashing(DashVector);
+	}
+
+	ApplyDash(DashVector);
+}
+
+void ARunnerPlayerController::ApplyDash(const FVector& Direction)
+{
+	DashState->bDashing = true;
+	DashState->bExecuting = true;
+
+	const FVector StartLocation = GetCharacter()->GetActorLocation();
+
+	TSharedPtr<FRootMotionSource_MoveToDynamicForce> DashMotion = MakeShared<FRootMotionSource_MoveToDynamicForce>();
+	DashMotion->InstanceName = TEXT("RunnerDash");
+	DashMotion->AccumulateMode = ERootMotionAccumulateMode::Override;
+	/*only drive X and Y, gravity and the floor keep handling Z so we follow slopes and fall off ledges*/
+	DashMotion->Settings.SetFlag(ERootMotionSourceSettingsFlags::IgnoreZAccumulate);
+	DashMotion->Priority = 500;
+	DashMotion->Duration = DashExecTime;
+	DashMotion->StartLocation = StartLocation;
+	DashMotion->InitialTargetLocation = StartLocation + Direction * DashDistance;
+	DashMotion->TargetLocation = DashMotion->InitialTargetLocation;
+	DashMotion->bRestrictSpeedToExpected = true;
+	DashMotion->TimeMappingCurve = DashCurve;
+	/*stop when the dash is done, like it always did*/
+	DashMotion->FinishVelocityParams.Mode = ERootMotionFinishVelocityMode::SetVelocity;
+	DashMotion->FinishVelocityParams.SetVelocity = FVector::ZeroVector;
+
+	DashState->RootMotionSourceID = GetCharacter()->GetCharacterMovement()->ApplyRootMotionSource(DashMotion);
+
+	GetWorldTimerManager().SetTimer(DashState->TimerHandle, this, &ARunnerPlayerController::StopDashing, DashExecTime, false);
+}
+
+bool ARunnerPlayerController::ServerStartDashing_Validate(const FVector& Direction)
+{
+	return !Direction.ContainsNaN();
+}
+
+void ARunnerPlayerController::ServerStartDashing_Implementation(const FVector& Direction)
+{
+	/*a client without the dash ability can still send this, refuse it*/
+	if (!HasAbility(ERunnerAbility::IR_Dash) || GetCharacter() == nullptr || !CanDash())
+	{
+		return;
+	}
+
+	ApplyDash(Direction.GetSafeNormal2D());
 }
 
 void ARunnerPlayerController::ResetDash()
 {
-	bDashing = false;
+	DashState->bDashing = false;
 }
 
 bool ARunnerPlayerController::CanDash()
 {
-	if (bCrouching || bDashing)
+	if (!HasAbility(ERunnerAbility::IR_Dash) || bCrouching || DashState->bDashing)
 	{
 		return false;
 	}
@@ -368,6 +755,26 @@ bool ARunnerPlayerController::CanDash()
 	return true;
 }
 
+float ARunnerPlayerController::EvaluateDashCurve(float Alpha) const
+{
+	Alpha = FMath::Clamp(Alpha, 0.0f, 1.0f);
+
+	if (DashCurve != nullptr)
+	{
+		return DashCurve->GetFloatValue(Alpha);
+	}
+
+	/*constant speed, same as the root motion source without a curve*/
+	return Alpha;
+}
+
+FVector ARunnerPlayerController::PredictDashLocation(const FVector& Start, const FVector& Direction, float Time) const
+{
+	const float Alpha = DashExecTime > 0.0f ? Time / DashExecTime : 1.0f;
+
+	return Start + Direction * DashDistance * EvaluateDashCurve(Alpha);
+}
+
 void ARunnerPlayerController::StartSliding()
 {
 	FHitResult FloorHitResult;
@@ -483,3 +890,60 @@ void ARunnerPlayerController::OnMovementStateChange(EMovementState PreviousMovem
 	}
 	}
 }
+
+void ARunnerPlayerController::RecordMovementTelemetry(float DeltaTime, float TickDuration)
+{
+	if (GetCharacter() == nullptr)
+	{
+		return;
+	}
+
+	ERunnerTelemetryFlags Flags = ERunnerTelemetryFlags::None;
+	if (bCrouching)
+	{
+		Flags |= ERunnerTelemetryFlags::Crouching;
+	}
+	if (bSprinting)
+	{
+		Flags |= ERunnerTelemetryFlags::Sprinting;
+	}
+	if (DashState && DashState->bExecuting)
+	{
+		Flags |= ERunnerTelemetryFlags::Dashing;
+	}
+	if (GetCharacter()->GetCharacterMovement()->IsFalling())
+	{
+		Flags |= ERunnerTelemetryFlags::Falling;
+	}
+
+	FRunnerMovementTelemetryRecord Record;
+	Record.Time = GetWorld()->GetTimeSeconds();
+	Record.DeltaTime = DeltaTime;
+	Record.TickDuration = TickDuration;
+	Record.Velocity = GetCharacter()->GetVelocity();
+	Record.FloorNormal = GetCharacter()->GetCharacterMovement()->CurrentFloor.HitResult.Normal;
+	Record.TraceCount = FrameTraceCount;
+	Record.MovementState = static_cast<uint8>(MovementState);
+	Record.Flags = static_cast<uint8>(Flags);
+
+	MovementTelemetry.Append(Record);
+	FrameTraceCount = 0;
+}
+
+void ARunnerPlayerController::ValidateAbilities()
+{
+	/*sliding is entered by crouching while sprinting so it needs both*/
+	if (HasAbility(ERunnerAbility::IR_Slide) && !(HasAbility(ERunnerAbility::IR_Sprint) && HasAbility(ERunnerAbility::IR_Crouch)))
+	{
+		UE_LOG(LogRunnerPlayerController, Warning, TEXT("%s: Slide needs both Sprint and Crouch, disabling Slide"), *GetName());
+		EnabledAbilities &= ~static_cast<uint8>(ERunnerAbility::IR_Slide);
+	}
+}
+
+void ARunnerPlayerController::FlushMovementTelemetry()
+{
+	if (MovementTelemetry.IsInitialized())
+	{
+		MovementTelemetry.FlushToFileAsync(MovementTelemetryFilePath);
+	}
+}
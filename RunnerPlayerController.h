@@ -5,8 +5,12 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/PlayerController.h"
+#include "RunnerMovementTelemetry.h"
+#include "RunnerAbilityState.h"
 #include "RunnerPlayerController.generated.h"
 
+class UCurveFloat;
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnStartSliding, class ARunnerGameCharacter*, Character);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnStartSprinting, class ARunnerGameCharacter*, Character);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnStopSliding, class ARunnerGameCharacter*, Character);
@@ -23,6 +27,22 @@ enum class EMovementState : uint8
 	IR_Sliding UMETA(DisplayName = "Sliding")
 };
 
+/*Abilities a controller archetype can be given. abilities left out are never bound to input, their actions are refused
+and their runtime state (FRunnerDashState, FRunnerVaultState) is never allocated. the tuning properties stay editable on every controller.
+Slide needs both Sprint and Crouch*/
+UENUM(BlueprintType, meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class ERunnerAbility : uint8
+{
+	IR_None = 0 UMETA(Hidden),
+	IR_Sprint = 1 << 0 UMETA(DisplayName = "Sprint"),
+	IR_Crouch = 1 << 1 UMETA(DisplayName = "Crouch"),
+	IR_Slide = 1 << 2 UMETA(DisplayName = "Slide"),
+	IR_Dash = 1 << 3 UMETA(DisplayName = "Dash"),
+	IR_Vault = 1 << 4 UMETA(DisplayName = "Vault"),
+	IR_All = IR_Sprint | IR_Crouch | IR_Slide | IR_Dash | IR_Vault UMETA(Hidden)
+};
+ENUM_CLASS_FLAGS(ERunnerAbility)
+
 UCLASS()
 class RUNNERGAME_API ARunnerPlayerController : public APlayerController
 {
@@ -45,6 +65,25 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Camera)
 		float BaseLookUpRate;
 
+	//
+	// INPUT
+	//
+	/*stick input shorter than this is treated as 0, the rest is rescaled so input still starts at 0. not applied to mouse look*/
+	UPROPERTY(EditDefaultsOnly, Category = Input, meta = (ClampMin = "0.0", ClampMax = "0.99"))
+	float InputDeadZone;
+	/*response curve of the stick after the dead zone. 1 is linear, higher gives finer control near the center*/
+	UPROPERTY(EditDefaultsOnly, Category = Input, meta = (ClampMin = "0.1"))
+	float InputResponseExponent;
+	/*this frame MoveForward in X and MoveRight in Y, submitted once in PostProcessInput*/
+	UPROPERTY(VisibleAnywhere, Category = Input)
+	FVector2D PendingMoveInput;
+	/*this frame TurnRate in X and LookUpRate in Y, mouse deltas submitted as they are once in PostProcessInput*/
+	UPROPERTY(VisibleAnywhere, Category = Input)
+	FVector2D PendingLookInput;
+	/*this frame TurnRateGamepad in X and LookUpRateGamepad in Y, submitted once in PostProcessInput scaled by the Base rates*/
+	UPROPERTY(VisibleAnywhere, Category = Input)
+	FVector2D PendingLookRateInput;
+
 	//
 	// MovementState 
 	// 
@@ -52,6 +91,13 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|MovementState")
 	EMovementState MovementState;
 
+	//
+	// ABILITIES
+	//
+	/*Which abilities this controller has. ie: spectator bots never dash, some NPC never slide*/
+	UPROPERTY(EditDefaultsOnly, Category = "Movement|Abilities", meta = (Bitmask, BitmaskEnum = "ERunnerAbility"))
+	uint8 EnabledAbilities;
+
 	//
 	// CROUCHING
 	//
@@ -128,10 +174,28 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Movement|Sliding")
 	float SlideMultiplier;
 
+	//
+	// VAULTING
+	//
+	/*how often we look ahead for a ledge while sprinting or sliding, lower is more responsive but costs more sweeps*/
+	UPROPERTY(EditDefaultsOnly, Category = "Movement|Vaulting")
+	float VaultQueryInterval;
+	/*how far in front of the capsule the vaulting component can grab a ledge. should match the vaulting component*/
+	UPROPERTY(EditDefaultsOnly, Category = "Movement|Vaulting")
+	float VaultReachDistance;
+	/*how long a found ledge stays valid before the jump press has to ask again*/
+	UPROPERTY(EditDefaultsOnly, Category = "Movement|Vaulting")
+	float VaultCandidateMaxAge;
+	/*how much the controller can turn away from where it was facing during the look ahead. 1 means facing the exact same way*/
+	UPROPERTY(EditDefaultsOnly, Category = "Movement|Vaulting")
+	float VaultCandidateMinFacingDot;
+	/*look ahead state, only there if this controller can vault*/
+	TUniquePtr<FRunnerVaultState> VaultState;
+
 	//
 	// DASHING
 	//
-	/*the maximum distance of the Dash*/
+	/*the distance covered by the Dash. the movement component steps up, slides along walls and follows slopes on the way*/
 	UPROPERTY(EditDefaultsOnly, Category = "Movement|Dashing")
 	float DashDistance;
 	/*The cooldown of the Dash*/
@@ -140,15 +204,12 @@ protected:
 	/*Time it takes for the Dash to Execute*/
 	UPROPERTY(EditDefaultsOnly, Category = "Movement|Dashing")
 	float DashExecTime;
-	/*braking factor of the dash higher factor means more abrupt stop*/
+	/*Shape of the Dash: X is the elapsed fraction of DashExecTime, Y is the fraction of DashDistance covered. both go from 0 to 1
+	if not set the dash moves at a constant speed*/
 	UPROPERTY(EditDefaultsOnly, Category = "Movement|Dashing")
-	float DashBrakingFrictionFactor;
-	/*tells us if this contoller is Dashing*/
-	UPROPERTY(VisibleAnywhere, Category = "Movement|Dashing")
-	bool bDashing;
-	/*Timer handler For The Dash Execute Time then Cooldown*/
-	UPROPERTY(VisibleAnywhere, Category = "Movement|Dashing")
-	FTimerHandle TimerHandle_Dashing;
+	UCurveFloat* DashCurve;
+	/*Dash state, only there if this controller can dash*/
+	TUniquePtr<FRunnerDashState> DashState;
 	/*Delegate Where we can do stuff at the strat of the Dash
 	this delegates is to implement in blueprints*/
 	UPROPERTY(EditDefaultsOnly, BlueprintAssignable)
@@ -157,14 +218,52 @@ protected:
 	this delegates is to implement in blueprints*/
 	UPROPERTY(EditDefaultsOnly, BlueprintAssignable)
 	FOnStopDashing OnStopDashing;
+
+	//
+	// TELEMETRY
+	//
+	/*records a small movement trace every frame, written to Saved/Telemetry/<Controller>_<Session start>.bin
+	periodically, on the FlushMovementTelemetry console command and when play ends*/
+	UPROPERTY(EditDefaultsOnly, Category = "Telemetry")
+	bool bRecordMovementTelemetry;
+	/*how many frames the telemetry keeps, older frames get overwritten*/
+	UPROPERTY(EditDefaultsOnly, Category = "Telemetry", meta = (EditCondition = "bRecordMovementTelemetry", ClampMin = "1"))
+	int32 MovementTelemetryCapacity;
+	/*how often the telemetry is written to disk in the background, in seconds. 0 only writes on demand and when play ends*/
+	UPROPERTY(EditDefaultsOnly, Category = "Telemetry", meta = (EditCondition = "bRecordMovementTelemetry", ClampMin = "0.0"))
+	float MovementTelemetryFlushInterval;
+	/*where this session telemetry is written*/
+	UPROPERTY(VisibleAnywhere, Category = "Telemetry")
+	FString MovementTelemetryFilePath;
+	/*Timer handler for the periodic telemetry flush*/
+	UPROPERTY(VisibleAnywhere, Category = "Telemetry")
+	FTimerHandle TimerHandle_TelemetryFlush;
+	/*the recorded frames*/
+	FRunnerMovementTelemetry MovementTelemetry;
+	/*how many traces this controller issued since the last recorded frame*/
+	uint16 FrameTraceCount;
 protected:
 
 
 	// 
 	// BASICS
 	//
+	// Called after the components are initialized, before input is set up
+	virtual void PostInitializeComponents() override;
+
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+
+	// Called when this controller stops controlling its pawn
+	virtual void OnUnPossess() override;
+
+#if WITH_EDITOR
+	// Called when a property is changed in the editor
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	// Called when the game ends or when destroyed
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	
 	//Called every frames
 	virtual void Tick(float DeltaTime) override;
@@ -172,17 +271,35 @@ protected:
 	// Called to bind functionality to input
 	virtual void SetupInputComponent() override;
 
+	// Called after all the input of the frame was processed
+	virtual void PostProcessInput(const float DeltaTime, const bool bGamePaused) override;
+
+	// 
+	// INPUT
+	//
+	/*applies the radial dead zone and response curve to a stick*/
+	UFUNCTION(Category = Input)
+	FVector2D ApplyInputResponse(const FVector2D& Value) const;
+
 	// 
 	// CAMERA CONTROL
 	//
-	/* Called via input to turn at a given rate.*/
+	/* Called via input to turn by the mouse delta.*/
 	UFUNCTION(Category = Camera)
 	void TurnRate(float Rate);
 
-	/*Called via input to turn look up/down at a given rate.*/
+	/*Called via input to turn look up/down by the mouse delta.*/
 	UFUNCTION(Category = Camera)
 	void LookUpRate(float Rate);
 
+	/* Called via input to turn at a given rate, 1 is BaseTurnRate. for gamepad sticks*/
+	UFUNCTION(Category = Camera)
+	void TurnRateGamepad(float Rate);
+
+	/*Called via input to turn look up/down at a given rate, 1 is BaseLookUpRate. for gamepad sticks*/
+	UFUNCTION(Category = Camera)
+	void LookUpRateGamepad(float Rate);
+
 	// 
 	// WAlKING
 	//
@@ -237,6 +354,20 @@ protected:
 	/*Handles the end of this controller jumping action*/
 	UFUNCTION(Category = "Movement|Jumping")
 	void StopJumping();
+	/*Handles the start of the jumping action for controllers that can vault: vaults if there is a ledge, then jumps*/
+	UFUNCTION(Category = "Movement|Jumping")
+	void StartVaultingOrJumping();
+
+	// 
+	// VAULTING
+	//
+	/*Sweeps ahead of the character while sprinting or sliding, as far as it can get before the next look ahead, and caches the ledge it finds for the next jump press.
+	a ledge that is not in reach yet gets asked again right when the character reaches it*/
+	UFUNCTION(Category = "Movement|Vaulting")
+	void UpdateVaultCandidate();
+	/*determines if this controller can vault right now. uses the cached look ahead when it is still valid, asks the vaulting component otherwise*/
+	UFUNCTION(Category = "Movement|Vaulting")
+	bool CanVault();
 
 	// 
 	// DASHING
@@ -256,6 +387,16 @@ protected:
 	/*determine if this controller can dash*/
 	UFUNCTION(Category = "Movement|Dashing")
 	bool CanDash();
+	/*hands the Dash to the movement component as a root motion source so it handles collision like any other move*/
+	UFUNCTION(Category = "Movement|Dashing")
+	void ApplyDash(const FVector& Direction);
+	/*asks the server to do the same Dash as the owning client. this is not ordered with the movement component moves
+	so the server starts the dash at a slightly different time and the client should expect small corrections*/
+	UFUNCTION(Server, Reliable, WithValidation, Category = "Movement|Dashing")
+	void ServerStartDashing(const FVector& Direction);
+	/*fraction of DashDistance covered at the given fraction of DashExecTime*/
+	UFUNCTION(Category = "Movement|Dashing")
+	float EvaluateDashCurve(float Alpha) const;
 
 	//
 	// SLIDING 
@@ -283,8 +424,32 @@ protected:
 	UFUNCTION(Category = "Movement|MovementState")
 	void OnMovementStateChange(EMovementState PreviousMovementState);
 
+	//
+	// ABILITIES
+	//
+	/*removes ability combinations that cannot work, ie: Slide without Crouch or Sprint*/
+	void ValidateAbilities();
+
+	//
+	// TELEMETRY
+	//
+	/*adds this frame to the movement telemetry*/
+	void RecordMovementTelemetry(float DeltaTime, float TickDuration);
+
+public:
+	/*writes the movement telemetry to disk in the background. also a console command*/
+	UFUNCTION(Exec, Category = "Telemetry")
+	void FlushMovementTelemetry();
+
 public:
 	/*Helper Function that returns the current movement state*/
 	UFUNCTION(BlueprintCallable, Category = "Movement|MovementState")
 	FORCEINLINE EMovementState GetMovementState() {return MovementState;}
+
+	/*where a Dash started at Start going in Direction would be after Time seconds, ignoring collision. useful for AI and server validation*/
+	UFUNCTION(BlueprintCallable, Category = "Movement|Dashing")
+	FVector PredictDashLocation(const FVector& Start, const FVector& Direction, float Time) const;
+
+	/*Helper Function that tells us if this controller has the given ability*/
+	FORCEINLINE bool HasAbility(ERunnerAbility Ability) const { return (EnabledAbilities & static_cast<uint8>(Ability)) != 0; }
 };
@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RunnerTelemetryExportCommandlet.h"
+#include "RunnerMovementTelemetry.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogRunnerTelemetryExport, Log, All);
+
+
+URunnerTelemetryExportCommandlet::URunnerTelemetryExportCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 URunnerTelemetryExportCommandlet::Main(const FString& Params)
+{
+	FString InPath;
+	if (!FParse::Value(*Params, TEXT("In="), InPath))
+	{
+		UE_LOG(LogRunnerTelemetryExport, Error, TEXT("Missing -In=<File.bin or Folder>"));
+		return 1;
+	}
+
+	TArray<FString> BinaryFiles;
+	FString OutPath;
+
+	if (IFileManager::Get().DirectoryExists(*InPath))
+	{
+		IFileManager::Get().FindFiles(BinaryFiles, *(InPath / TEXT("*.bin")), true, false);
+		for (FString& BinaryFile : BinaryFiles)
+		{
+			BinaryFile = InPath / BinaryFile;
+		}
+	}
+	else
+	{
+		BinaryFiles.Add(InPath);
+		FParse::Value(*Params, TEXT("Out="), OutPath);
+	}
+
+	int32 NumFailed = 0;
+	for (const FString& BinaryFile : BinaryFiles)
+	{
+		const FString CSVFile = OutPath.IsEmpty() ? FPaths::ChangeExtension(BinaryFile, TEXT("csv")) : OutPath;
+
+		if (FRunnerMovementTelemetry::ExportToCSV(BinaryFile, CSVFile))
+		{
+			UE_LOG(LogRunnerTelemetryExport, Display, TEXT("%s -> %s"), *BinaryFile, *CSVFile);
+		}
+		else
+		{
+			UE_LOG(LogRunnerTelemetryExport, Error, TEXT("Could not convert %s"), *BinaryFile);
+			++NumFailed;
+		}
+	}
+
+	return NumFailed == 0 ? 0 : 1;
+}
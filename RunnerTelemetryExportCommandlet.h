@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "RunnerTelemetryExportCommandlet.generated.h"
+
+/*
+Turns movement telemetry files written by ARunnerPlayerController into CSV.
+usage: UE4Editor-Cmd.exe <Project> -run=RunnerTelemetryExport -In=<File.bin or Folder> [-Out=<File.csv>]
+a folder converts every .bin in it next to the original. without -Out a file is converted next to the original
+*/
+UCLASS()
+class RUNNERGAME_API URunnerTelemetryExportCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	URunnerTelemetryExportCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};